@@ -1,5 +1,6 @@
 // Sebastian Diaz G
 #define _XOPEN_SOURCE 700
+#define _DEFAULT_SOURCE   // MAP_ANONYMOUS / MAP_NORESERVE para las pilas de fibras
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -9,6 +10,9 @@
 #include <ctype.h>
 #include <unistd.h>
 #include <time.h>
+#include <ucontext.h>
+#include <sys/resource.h>
+#include <sys/mman.h>
 
 // ------------------- Utils -------------------
 #define MAX_PATH_POINTS 4096
@@ -16,15 +20,30 @@
 static int abs_i(int x){return x<0?-x:x;}
 static int manhattan(int x1,int y1,int x2,int y2){ return abs_i(x1-x2) + abs_i(y1-y2); }
 
+// Fibra en ejecucion en este hilo (NULL fuera de --fibers); ver la seccion Fibers.
+// barrier_wait, sleep_us y actor_wait_turn la consultan para no bloquear el hilo desde una fibra.
+struct Fiber;
+static _Thread_local struct Fiber *cur_fiber = NULL;
+static void fiber_defer_sleep(int us);
+static bool fiber_turn(void);
+
 // micro-sleep
 static inline void sleep_us(int us) {
     if (us <= 0) return;
+    if (cur_fiber){ fiber_defer_sleep(us); return; }
     struct timespec ts;
     ts.tv_sec  = us / 1000000;
     ts.tv_nsec = (long)(us % 1000000) * 1000L;
     nanosleep(&ts, NULL);
 }
 
+// reloj monotonico en nanosegundos (para medir el costo de cada tick)
+static inline long long now_ns(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
 // ANSI clear screen
 static inline void ansi_clear(void){ printf("\033[H\033[J"); }
 
@@ -45,7 +64,10 @@ static void barrier_init(barrier_t *b, int parties){
     b->cycle = 0;
 }
 
+static void fiber_park(barrier_t *b);
+
 static void barrier_wait(barrier_t *b){
+    if (cur_fiber){ fiber_park(b); return; }
     pthread_mutex_lock(&b->mtx);
     int cycle = b->cycle;
     if (--b->count == 0){
@@ -74,7 +96,6 @@ typedef struct {
     int hp;
     int attack;
     int attack_range;
-    bool alive;
 } Actor;
 
 typedef struct {
@@ -82,28 +103,57 @@ typedef struct {
     Point *path;
     int path_len;     // numero de waypoints (excluyendo la posicion inicial)
     int path_idx;     // siguiente indice de waypoint
-    bool engaged;     // verdadero si esta peleando (dejar de moverse)
-    pthread_t th;
-    
+    int target;       // monstruo a atacar decidido en este tick (-1: ninguno)
 } Hero;
 
+// Bitsets para los estados booleanos (alive/alerted/engaged): 1 bit por actor.
+static inline bool bit_get(const uint64_t *bs, int i){ return (bs[i >> 6] >> (i & 63)) & 1u; }
+static inline void bit_put(uint64_t *bs, int i, bool v){
+    if (v) bs[i >> 6] |= 1ull << (i & 63);
+    else   bs[i >> 6] &= ~(1ull << (i & 63));
+}
+static inline size_t bitset_words(int n){ return ((size_t)n + 63) / 64; }
+
+// Monstruos en formato compacto (estructura de arreglos): coordenadas de 16 bits cuando
+// GRID_SIZE lo permite, HP empaquetado con el indice de su perfil (ataque/vision/rango)
+// y bitsets para alive/alerted. El id de un monstruo es su indice + 1.
+// Si la configuracion no cabe en el empaquetado (HP o perfiles distintos por encima de
+// los limites), se usa el formato ancho: HP de 32 bits y un perfil por monstruo.
+#define MON_HP_BITS   20
+#define MON_HP_MAX    ((1u << MON_HP_BITS) - 1)   // HP maximo empaquetado
+#define MON_PROF_MAX  (1u << (32 - MON_HP_BITS))  // perfiles distintos empaquetados
+
 typedef struct {
-    int id;
-    Actor a;
+    int attack;
     int vision;
-    bool alerted;
-    pthread_t th;
-} Monster;
+    int attack_range;
+} MonsterProfile;
+
+typedef struct {
+    bool coord16;            // true: x16/y16; false: x32/y32
+    bool packed;             // true: hp_prof; false: hp y un perfil por monstruo (formato ancho)
+    uint16_t *x16, *y16;
+    int32_t  *x32, *y32;
+    uint32_t *hp_prof;       // HP en los MON_HP_BITS bajos | indice de perfil en los altos
+    uint32_t *hp;            // formato ancho: HP del monstruo i; su perfil es prof[i]
+    uint64_t *alive;         // bitset
+    uint64_t *alerted;       // bitset
+    int32_t  *target;        // heroe mas cercano decidido en este tick (-1: ninguno)
+    MonsterProfile *prof;
+    int nprof;
+    size_t bytes;            // bytes reservados por el store (arreglos, bitsets y perfiles)
+} MonsterStore;
 
 // --------------------------- Global State ------------------------
 static Grid G;
 static Hero *heroes = NULL;
 static int H = 0;                         // number of heroes
-static Monster *monsters = NULL;
+static uint64_t *hero_alive = NULL;       // bitset
+static uint64_t *hero_engaged = NULL;     // bitset: peleando (dejar de moverse)
+static MonsterStore MS;
 static int M = 0;                         // number of monsters
 static volatile int simulation_over = 0;  // end flag
 
-static pthread_mutex_t world_mtx = PTHREAD_MUTEX_INITIALIZER;
 static barrier_t tick_barrier;
 static barrier_t tick_barrier2;
 
@@ -115,12 +165,94 @@ static int ascii_live = 0;       // renderear ASCII cada tick (animado)
 static int ascii_only = 0;       // renderizar una vez y salir
 static int ascii_show_path = 1;  // dibujar el camino planeado como '.'
 
+// Viewport del render ASCII (--view x0,y0,w,h / --follow HERO_n / --zoom k)
+#define FOLLOW_DEFAULT_W 60   // ventana por defecto de la camara que sigue a un heroe
+#define FOLLOW_DEFAULT_H 20
+#define RENDER_LIST_MAX  200  // maximo de actores listados bajo la vista con zoom 1
+static int view_x0 = 0, view_y0 = 0;
+static int view_w = 0, view_h = 0;   // 0: todo el mundo
+static int view_follow = -1;         // indice del heroe seguido (-1: camara fija)
+static int view_zoom = 1;            // celdas por lado agregadas en cada glifo
+
+// Planificador adaptativo: con pocos actores vivos, las dos barreras por tick
+// entre 1+H+M hilos cuestan mas que las decisiones; el supervisor decide inline.
+// Se arranca en serial para medir el costo real y solo se pasa a paralelo si compensa.
+#define SCHED_SERIAL_MAX_LIVE   64        // bajar a serial con <= 64 actores vivos
+#define SCHED_PARALLEL_GAIN     125       // subir si costo serial > 125% del paralelo (medido o estimado)
+#define SCHED_THREAD_TICK_NS    10000LL   // costo estimado por hilo y tick (despertar en dos barreras)
+#define SCHED_FIBER_TICK_NS     200LL     // costo estimado por fibra y tick (cuatro cambios de contexto)
+#define SCHED_HOLD_TICKS        3         // ticks consecutivos antes de cambiar (histeresis)
+
+typedef enum { SCHED_AUTO, SCHED_FORCE_SERIAL, SCHED_FORCE_PARALLEL } SchedPolicy;
+static SchedPolicy sched_policy = SCHED_AUTO;
+static int sched_profile = 0;    // imprimir decisiones del planificador (stderr)
+
+static pthread_mutex_t mode_mtx = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  mode_cv  = PTHREAD_COND_INITIALIZER;
+static int serial_mode = 0;      // 1: el supervisor actua inline y los hilos esperan en mode_cv
+static int threads_spawned = 0;  // los hilos se crean la primera vez que se entra en paralelo
+static pthread_t *actor_th = NULL; // H hilos de heroes seguidos de M de monstruos
+
+// Fibras (--fibers): cada actor corre como fibra de usuario sobre unos pocos hilos del SO
+#define FIBER_STACK_SIZE (8 * 1024)  // pila util por fibra (multiplo de pagina), mas una pagina guarda
+#define FIBER_MAP_RESERVE 4096       // entradas de vm.max_map_count que se dejan al resto del proceso
+#ifndef MADV_GUARD_INSTALL
+#define MADV_GUARD_INSTALL 102       // Linux >= 6.13: pagina guarda sin partir el mapeo
+#endif
+static int fiber_mode = 0;
+static int fiber_workers = 0;    // --workers N (0: uno por CPU)
+
+// Modo escala (--scale): eleva los limites de actores y no usa recursos del SO por actor
+#define ACTOR_LIMIT        10000      // maximo de HERO_COUNT / MONSTER_COUNT
+#define ACTOR_LIMIT_SCALE  16000000   // maximo con --scale
+static int scale_mode = 0;
+static int bench_mode = 0;       // --bench: sin salida por tick; reporta memoria y tiempo por tick
+
+// --------------------------- Actor Accessors ---------------------
+static inline bool hero_is_alive(int h){ return bit_get(hero_alive, h); }
+static inline bool hero_is_engaged(int h){ return bit_get(hero_engaged, h); }
+
+static inline int mon_x(int i){ return MS.coord16 ? MS.x16[i] : MS.x32[i]; }
+static inline int mon_y(int i){ return MS.coord16 ? MS.y16[i] : MS.y32[i]; }
+static inline void mon_set_xy(int i, int x, int y){
+    if (MS.coord16){ MS.x16[i] = (uint16_t)x; MS.y16[i] = (uint16_t)y; }
+    else           { MS.x32[i] = x;           MS.y32[i] = y; }
+}
+static inline int mon_hp(int i){ return MS.packed ? (int)(MS.hp_prof[i] & MON_HP_MAX) : (int)MS.hp[i]; }
+static inline void mon_set_hp(int i, int hp){
+    if (MS.packed) MS.hp_prof[i] = (MS.hp_prof[i] & ~MON_HP_MAX) | (uint32_t)hp;
+    else           MS.hp[i] = (uint32_t)hp;
+}
+static inline const MonsterProfile *mon_prof(int i){ return &MS.prof[MS.packed ? MS.hp_prof[i] >> MON_HP_BITS : (uint32_t)i]; }
+static inline bool mon_is_alive(int i){ return bit_get(MS.alive, i); }
+static inline bool mon_is_alerted(int i){ return bit_get(MS.alerted, i); }
+
+// bytes por monstruo del formato en uso (empaquetado: sin contar la tabla de perfiles), incluida la decision del tick
+static double monster_slot_bytes(void){
+    double coords = MS.coord16 ? 2 * sizeof(uint16_t) : 2 * sizeof(int32_t);
+    double hp = MS.packed ? sizeof(uint32_t) : sizeof(uint32_t) + sizeof(MonsterProfile);
+    return coords + hp + sizeof(int32_t) + 2.0 / 8.0;
+}
+
+// pico de memoria residente del proceso, en bytes (ru_maxrss esta en KiB en Linux)
+static long long peak_rss_bytes(void){
+    struct rusage ru;
+    if (getrusage(RUSAGE_SELF, &ru) != 0) return 0;
+    return (long long)ru.ru_maxrss * 1024LL;
+}
+
+static void monster_store_free(void){
+    free(MS.x16); free(MS.y16); free(MS.x32); free(MS.y32);
+    free(MS.hp_prof); free(MS.hp); free(MS.alive); free(MS.alerted); free(MS.target); free(MS.prof);
+    memset(&MS, 0, sizeof(MS));
+}
+
 // --------------------------- Helper Queries ----------------------
 static bool any_monster_alive_in_range(int x, int y, int range, int *out_idx){
     int best_i = -1;
     for (int i=0;i<M;i++){
-        if (!monsters[i].a.alive) continue;
-        if (manhattan(x,y, monsters[i].a.x, monsters[i].a.y) <= range){
+        if (!mon_is_alive(i)) continue;
+        if (manhattan(x,y, mon_x(i), mon_y(i)) <= range){
             best_i = i; break; // primer coincdcia
         }
     }
@@ -128,41 +260,70 @@ static bool any_monster_alive_in_range(int x, int y, int range, int *out_idx){
     return best_i != -1;
 }
 
-static bool any_monster_alive(){
-    for (int i=0;i<M;i++) if (monsters[i].a.alive) return true;
-    return false;
+static int count_monsters_alive(void){
+    int n = 0;
+    for (size_t w = 0; w < bitset_words(M); w++) n += __builtin_popcountll(MS.alive[w]);
+    return n;
+}
+
+// heroe vivo mas cercano a (x,y), o -1 si no queda ninguno
+static int nearest_hero_alive(int x, int y){
+    int best_h = -1;
+    int best_dist = 0;
+    for (int h=0; h<H; ++h){
+        if (!hero_is_alive(h)) continue;
+        int d0 = manhattan(x, y, heroes[h].a.x, heroes[h].a.y);
+        if (best_h == -1 || d0 < best_dist){ best_h = h; best_dist = d0; }
+    }
+    return best_h;
 }
 
 static void alert_neighbors(int src_idx){
-    Monster *src = &monsters[src_idx];
+    int sx = mon_x(src_idx), sy = mon_y(src_idx);
+    int vision = mon_prof(src_idx)->vision;
     for (int j=0;j<M;j++){
         if (j==src_idx) continue;
-        if (!monsters[j].a.alive) continue;
-        int d = manhattan(src->a.x, src->a.y, monsters[j].a.x, monsters[j].a.y);
-        if (d <= src->vision) monsters[j].alerted = true;
+        if (!mon_is_alive(j)) continue;
+        int d = manhattan(sx, sy, mon_x(j), mon_y(j));
+        if (d <= vision) bit_put(MS.alerted, j, true);
     }
 }
 
 // --------------------------- Actions -----------------------------
+/* Cada tick tiene dos pasos. Decidir (hero_decide/monster_decide): cada actor busca su
+   objetivo, que es el recorrido caro, leyendo el mundo tal como quedo al cerrar el tick
+   anterior; en este paso nadie escribe el mundo, asi que los actores deciden a la vez sin
+   candado. Aplicar (hero_act_index/monster_act): el supervisor aplica las decisiones en
+   orden fijo, heroes y luego monstruos, igual en modo serial y paralelo. */
+static void hero_decide(int h){
+    Hero *hh = &heroes[h];
+    hh->target = -1;
+    if (hero_is_alive(h)) any_monster_alive_in_range(hh->a.x, hh->a.y, hh->a.attack_range, &hh->target);
+}
+
+static void monster_decide(int i){
+    MS.target[i] = mon_is_alive(i) ? nearest_hero_alive(mon_x(i), mon_y(i)) : -1;
+}
+
 static void hero_act_index(int h){
     Hero *hh = &heroes[h];
-    if (!hh->a.alive) {
-        hh->engaged = false; // Si esta muerto, no esta peleando
+    if (!hero_is_alive(h)) {
+        bit_put(hero_engaged, h, false); // Si esta muerto, no esta peleando
         return;
     }
 
-    // Combatir si algun monstruo esta dentro del rango de ataque
-    int target = -1;
-    if (any_monster_alive_in_range(hh->a.x, hh->a.y, hh->a.attack_range, &target)){
-        hh->engaged = true;
-        if (target >= 0){
-            Monster *m = &monsters[target];
-            m->a.hp -= hh->a.attack;
-            if (m->a.hp <= 0) { m->a.hp = 0; m->a.alive = false; }
-        }
+    // Combatir si algun monstruo esta dentro del rango de ataque; si un heroe anterior
+    // ya mato al objetivo decidido, se vuelve a buscar (los monstruos aun no se movieron)
+    int target = hh->target;
+    if (target >= 0 && !mon_is_alive(target)) any_monster_alive_in_range(hh->a.x, hh->a.y, hh->a.attack_range, &target);
+    if (target >= 0){
+        bit_put(hero_engaged, h, true);
+        int hp = mon_hp(target) - hh->a.attack;
+        if (hp <= 0) { hp = 0; bit_put(MS.alive, target, false); }
+        mon_set_hp(target, hp);
         return; // No moverse mientras esta peleando
     }
-    hh->engaged = false;
+    bit_put(hero_engaged, h, false);
 
     // Movimiento sobre el camino
     if (hh->path_idx < hh->path_len){
@@ -177,85 +338,491 @@ static void hero_act_index(int h){
 
 
 static void monster_act(int i){
-    Monster *m = &monsters[i];
-    if (!m->a.alive) return;
+    if (!mon_is_alive(i)) return;
+    const MonsterProfile *p = mon_prof(i);
+    int mx = mon_x(i), my = mon_y(i);
 
-    // buscar el heroe mas cercano vivo
-    int best_h = -1;
-    int best_dist = 0;
-    for (int h=0; h<H; ++h){
-        if (!heroes[h].a.alive) continue;
-        int d0 = manhattan(m->a.x, m->a.y, heroes[h].a.x, heroes[h].a.y);
-        if (best_h == -1 || d0 < best_dist){ best_h = h; best_dist = d0; }
-    }
+    // heroe decidido; si otro monstruo lo mato en este tick, buscar de nuevo
+    int best_h = MS.target[i];
+    if (best_h >= 0 && !hero_is_alive(best_h)) best_h = nearest_hero_alive(mx, my);
     if (best_h == -1) return; // no heroes vivos
 
-    int d = best_dist;
+    int d = manhattan(mx, my, heroes[best_h].a.x, heroes[best_h].a.y);
 
     // Ver heroe -> alertar vecinos
-    if (!m->alerted && d <= m->vision){
-        m->alerted = true;
+    if (!mon_is_alerted(i) && d <= p->vision){
+        bit_put(MS.alerted, i, true);
         alert_neighbors(i);
     }
 
     // Attack?
-    if (d <= m->a.attack_range){
+    if (d <= p->attack_range){
         Hero *t = &heroes[best_h];
-    t->a.hp -= m->a.attack;
-    if (t->a.hp <= 0) { t->a.hp = 0; t->a.alive = false; }
+    t->a.hp -= p->attack;
+    if (t->a.hp <= 0) { t->a.hp = 0; bit_put(hero_alive, best_h, false); }
         return;
     }
 
     // Moverse hacia el heroe mas cercano si esta alertado
-    if (m->alerted){
+    if (mon_is_alerted(i)){
         Hero *t = &heroes[best_h];
-        if (m->a.x < t->a.x) m->a.x++;
-        else if (m->a.x > t->a.x) m->a.x--;
-        else if (m->a.y < t->a.y) m->a.y++;
-        else if (m->a.y > t->a.y) m->a.y--;
+        if (mx < t->a.x) mx++;
+        else if (mx > t->a.x) mx--;
+        else if (my < t->a.y) my++;
+        else if (my > t->a.y) my--;
+        mon_set_xy(i, mx, my);
     }
 }
 
 // --------------------------- Threads -----------------------------
+/* Espera mientras el supervisor ejecute los ticks en modo serial.
+   Devuelve false si la simulacion termino mientras el hilo estaba estacionado.
+   En una fibra no espera: su worker ya paso la compuerta por todo su tramo. */
+static bool actor_wait_turn(void){
+    if (cur_fiber) return fiber_turn();
+    pthread_mutex_lock(&mode_mtx);
+    while (serial_mode && !simulation_over){
+        pthread_cond_wait(&mode_cv, &mode_mtx);
+    }
+    bool go = !simulation_over;
+    pthread_mutex_unlock(&mode_mtx);
+    return go;
+}
+
 static void *hero_thread(void *arg){
     int h = (int)(intptr_t)arg;
-    for(;;){
-        pthread_mutex_lock(&world_mtx);
-        hero_act_index(h);
-        pthread_mutex_unlock(&world_mtx);
+    while (actor_wait_turn()){
+        /* Decidir sin candado: hasta la Fase A nadie escribe el mundo. */
+        hero_decide(h);
 
         if (tick_us>0) sleep_us(tick_us);
-        /* Fase A: finalizar las acciones de este tick. */
+        /* Fase A: todas las decisiones listas; el supervisor las aplica en orden. */
         barrier_wait(&tick_barrier);
 
         /* Fase B: esperar a que el supervisor decida si la simulacion ha terminado.
-        El supervisor establecera simulation_over entre las dos barreras. */
+        El supervisor establecera simulation_over entre las dos barreras;
+        actor_wait_turn lo observa al comenzar el siguiente ciclo. */
         barrier_wait(&tick_barrier2);
-
-        if (simulation_over) break;
     }
     return NULL;
 }
 
 static void *monster_thread(void *arg){
     int idx = (int)(intptr_t)arg;
-    for(;;){
-        pthread_mutex_lock(&world_mtx);
-        monster_act(idx);
-        pthread_mutex_unlock(&world_mtx);
+    while (actor_wait_turn()){
+        monster_decide(idx);
 
         if (tick_us>0) sleep_us(tick_us);
-    /* Fase A: terminar las acciones para este tick.*/
+    /* Fase A: terminar las decisiones para este tick.*/
     barrier_wait(&tick_barrier);
 
     /* Fase B: esperar la decision del supervisor*/
     barrier_wait(&tick_barrier2);
+    }
+    return NULL;
+}
 
-    if (simulation_over) break;
+// --------------------------- Fibers ------------------------------
+/* Con --fibers, hero_thread/monster_thread corren sin cambios como fibras (ucontext).
+   Cada worker (hilo del SO) posee un tramo fijo de fibras y, por fase, las reanuda
+   una por una hasta que todas se estacionan en la misma barrera; luego llega a la
+   barrera real una sola vez en nombre de todas. Asi la barrera tiene 1 + workers
+   participantes en vez de 1 + H + M. */
+typedef struct FiberWorker FiberWorker;
+
+#if defined(__x86_64__)
+/* Cambio de contexto propio para x86-64: guarda los registros callee-saved en la pila
+   y cambia rsp. Evita la llamada al sistema (sigprocmask) que swapcontext hace en cada
+   cambio; en otras arquitecturas se usa ucontext. */
+#define FIBER_ASM_SWITCH 1
+void doom_fiber_switch(void **save_sp, void *load_sp);
+__asm__(
+    ".pushsection .text\n"
+    ".globl doom_fiber_switch\n"
+    ".type doom_fiber_switch,@function\n"
+    "doom_fiber_switch:\n"
+    "    pushq %rbp\n"
+    "    pushq %rbx\n"
+    "    pushq %r12\n"
+    "    pushq %r13\n"
+    "    pushq %r14\n"
+    "    pushq %r15\n"
+    "    movq %rsp, (%rdi)\n"
+    "    movq %rsi, %rsp\n"
+    "    popq %r15\n"
+    "    popq %r14\n"
+    "    popq %r13\n"
+    "    popq %r12\n"
+    "    popq %rbx\n"
+    "    popq %rbp\n"
+    "    ret\n"
+    ".size doom_fiber_switch, .-doom_fiber_switch\n"
+    ".popsection\n");
+#else
+#define FIBER_ASM_SWITCH 0
+#endif
+
+typedef struct Fiber {
+#if FIBER_ASM_SWITCH
+    void *sp;
+#else
+    ucontext_t ctx;
+#endif
+    void *(*fn)(void *);   // hero_thread o monster_thread
+    void *arg;
+    FiberWorker *worker;
+    barrier_t *parked_on;  // barrera en la que se estaciono en esta fase
+    bool done;
+} Fiber;
+
+struct FiberWorker {
+#if FIBER_ASM_SWITCH
+    void *sched_sp;        // pila del bucle del worker
+#else
+    ucontext_t sched_ctx;  // contexto del bucle del worker
+#endif
+    Fiber *fibers;         // tramo [0, n) del arreglo global de fibras
+    int n;
+    char *stacks;          // pool mmap del tramo: n * (guarda + FIBER_STACK_SIZE)
+    size_t stacks_len;
+    int sleep_us;          // mayor pausa pedida por sus fibras en esta fase
+    bool go;               // resultado de la compuerta de modo para el tick que empieza
+    pthread_t th;
+};
+
+/* Cada pila lleva una pagina guarda debajo. Con MADV_GUARD_INSTALL la guarda no parte el
+   pool; si el kernel no lo soporta se usa mprotect(PROT_NONE), que deja dos mapeos por
+   fibra, y el limite de fibras sale de vm.max_map_count. */
+static bool fiber_guard_madvise(size_t page){
+    char *probe = mmap(NULL, 2 * page, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (probe == MAP_FAILED) return false;
+    bool ok = madvise(probe, page, MADV_GUARD_INSTALL) == 0;
+    munmap(probe, 2 * page);
+    return ok;
+}
+
+static long fiber_max_map_actors(void){
+    long maps = 65530; // valor por defecto de Linux
+    FILE *f = fopen("/proc/sys/vm/max_map_count", "r");
+    if (f){
+        if (fscanf(f, "%ld", &maps) != 1) maps = 65530;
+        fclose(f);
+    }
+    long n = (maps - FIBER_MAP_RESERVE) / 2;
+    return n > 0 ? n : 0;
+}
+
+static Fiber *fibers = NULL;
+static FiberWorker *workers = NULL;
+static int n_workers = 0;
+
+static void fiber_to_worker(Fiber *f){
+#if FIBER_ASM_SWITCH
+    doom_fiber_switch(&f->sp, f->worker->sched_sp);
+#else
+    swapcontext(&f->ctx, &f->worker->sched_ctx);
+#endif
+}
+
+static void worker_to_fiber(FiberWorker *w, Fiber *f){
+#if FIBER_ASM_SWITCH
+    doom_fiber_switch(&w->sched_sp, f->sp);
+#else
+    swapcontext(&w->sched_ctx, &f->ctx);
+#endif
+}
+
+/* barrier_wait dentro de una fibra: volver al worker, que llegara a la barrera real. */
+static void fiber_park(barrier_t *b){
+    Fiber *f = cur_fiber;
+    f->parked_on = b;
+    fiber_to_worker(f);
+}
+
+/* actor_wait_turn dentro de una fibra: responde lo que el worker leyo al pasar la compuerta. */
+static bool fiber_turn(void){
+    return cur_fiber->worker->go;
+}
+
+/* sleep_us dentro de una fibra: el worker duerme una sola vez antes de la barrera. */
+static void fiber_defer_sleep(int us){
+    FiberWorker *w = cur_fiber->worker;
+    if (us > w->sleep_us) w->sleep_us = us;
+}
+
+static void fiber_entry(void){
+    Fiber *f = cur_fiber;
+    f->fn(f->arg);
+    f->done = true;
+    fiber_to_worker(f); // no se vuelve a reanudar
+}
+
+/* Prepara la fibra para que el primer cambio de contexto entre en fiber_entry. */
+static void fiber_prepare(Fiber *f, char *stack){
+#if FIBER_ASM_SWITCH
+    uintptr_t top = ((uintptr_t)stack + FIBER_STACK_SIZE) & ~(uintptr_t)15;
+    uintptr_t *sp = (uintptr_t*)top;
+    *--sp = 0;                         // direccion de retorno ficticia: rsp+8 alineado a 16
+    *--sp = (uintptr_t)fiber_entry;    // destino del 'ret' de doom_fiber_switch
+    for (int r = 0; r < 6; ++r) *--sp = 0; // rbp, rbx, r12..r15
+    f->sp = sp;
+#else
+    getcontext(&f->ctx);
+    f->ctx.uc_stack.ss_sp = stack;
+    f->ctx.uc_stack.ss_size = FIBER_STACK_SIZE;
+    f->ctx.uc_link = NULL;
+    makecontext(&f->ctx, fiber_entry, 0);
+#endif
+}
+
+static void *fiber_worker(void *arg){
+    FiberWorker *w = arg;
+    barrier_t *b = &tick_barrier2; // al arrancar, las fibras entran en actor_wait_turn como tras la Fase B
+    for(;;){
+        /* Compuerta de modo: tras la Fase B cada fibra vuelve a actor_wait_turn. El worker espera
+           en mode_cv una sola vez por todo el tramo, fuera de las fibras, antes de reanudarlas. */
+        if (b == &tick_barrier2) w->go = actor_wait_turn();
+        b = NULL;
+        w->sleep_us = 0;
+        for (int k = 0; k < w->n; ++k){
+            Fiber *f = &w->fibers[k];
+            if (f->done) continue;
+            cur_fiber = f;
+            worker_to_fiber(w, f);
+            cur_fiber = NULL;
+            if (!f->done) b = f->parked_on;
+        }
+        if (!b) break; // todas las fibras terminaron
+        if (w->sleep_us > 0) sleep_us(w->sleep_us);
+        barrier_wait(b);
     }
     return NULL;
 }
 
+static void free_actor_fibers(void){
+    for (int k = 0; k < n_workers; ++k){
+        if (workers[k].stacks) munmap(workers[k].stacks, workers[k].stacks_len);
+    }
+    free(workers);
+    free(fibers);
+    workers = NULL; fibers = NULL; n_workers = 0;
+}
+
+/* Devuelve 0 si las fibras quedaron corriendo, 1 si no caben en esta maquina (se sigue
+   en serial) y -1 ante un error. */
+static int spawn_actor_fibers(void){
+    const int total = H + M;
+    const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    const size_t slot = page + FIBER_STACK_SIZE; // [guarda][pila]
+
+    // cada fibra deja residente la pagina de la cima de su pila y su Fiber; se reserva
+    // una cuarta parte de la memoria libre para el resto del proceso
+    long free_pages = sysconf(_SC_AVPHYS_PAGES);
+    long long need = (long long)total * (long long)(page + sizeof(Fiber));
+    if (free_pages > 0 && need > (long long)free_pages / 4 * 3 * (long long)page){
+        fprintf(stderr, "--fibers: %d fibers need about %lld MiB resident and only %lld MiB are free; running serial\n",
+                total, need >> 20, ((long long)free_pages * (long long)page) >> 20);
+        return 1;
+    }
+    const bool guard_madvise = fiber_guard_madvise(page);
+    if (!guard_madvise){
+        long cap = fiber_max_map_actors();
+        if (total > cap){
+            fprintf(stderr, "--fibers: guard pages without MADV_GUARD_INSTALL allow up to %ld fibers "
+                            "(vm.max_map_count); this config has %d; running serial\n", cap, total);
+            return 1;
+        }
+    }
+
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    n_workers = fiber_workers > 0 ? fiber_workers : (ncpu > 0 ? (int)ncpu : 1);
+    if (n_workers > total) n_workers = total;
+
+    int parties = 1 + n_workers; // supervisor + workers
+    barrier_init(&tick_barrier, parties);
+    barrier_init(&tick_barrier2, parties);
+
+    fibers = calloc((size_t)total, sizeof(Fiber));
+    workers = calloc((size_t)n_workers, sizeof(FiberWorker));
+    if (!fibers || !workers){ fprintf(stderr, "OOM allocating fibers\n"); return -1; }
+
+    for (int k = 0; k < n_workers; ++k){
+        FiberWorker *w = &workers[k];
+        int lo = (int)((long long)total * k / n_workers);
+        int hi = (int)((long long)total * (k + 1) / n_workers);
+        w->fibers = &fibers[lo];
+        w->n = hi - lo;
+        /* MAP_NORESERVE: solo ocupan memoria las paginas que cada fibra realmente toca */
+        w->stacks_len = (size_t)w->n * slot;
+        w->stacks = mmap(NULL, w->stacks_len, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (w->stacks == MAP_FAILED){
+            w->stacks = NULL;
+            perror("mmap(fiber stacks)");
+            fprintf(stderr, "--fibers: running serial\n");
+            free_actor_fibers();
+            return 1;
+        }
+        for (int j = 0; j < w->n; ++j){
+            char *guard = w->stacks + (size_t)j * slot;
+            int rc = guard_madvise ? madvise(guard, page, MADV_GUARD_INSTALL) : mprotect(guard, page, PROT_NONE);
+            if (rc != 0){ perror("fiber guard page"); return -1; }
+        }
+        for (int j = 0; j < w->n; ++j){
+            Fiber *f = &w->fibers[j];
+            int t = lo + j;
+            f->fn = t < H ? hero_thread : monster_thread;
+            f->arg = (void*)(intptr_t)(t < H ? t : t - H);
+            f->worker = w;
+            fiber_prepare(f, w->stacks + (size_t)j * slot + page);
+        }
+    }
+    for (int k = 0; k < n_workers; ++k){
+        if (pthread_create(&workers[k].th, NULL, fiber_worker, &workers[k])!=0){ perror("pthread_create(fiber worker)"); return -1; }
+    }
+    return 0;
+}
+
+static void join_actor_fibers(void){
+    for (int k = 0; k < n_workers; ++k) pthread_join(workers[k].th, NULL);
+    free_actor_fibers();
+}
+
+// --------------------------- Scheduler ---------------------------
+static long long sched_serial_ewma = 0;   // costo promedio (ns) de un tick serial
+static long long sched_parallel_ewma = 0; // costo promedio (ns) de un tick paralelo (0: sin medir)
+static int sched_skip = 0;                // ticks a no medir (arranque de hilos tras un cambio)
+static int sched_cpus = 1;                // nucleos en linea (las decisiones se reparten entre ellos)
+static int sched_streak = 0;              // ticks consecutivos pidiendo el cambio de modo
+static int sched_ticks_serial = 0, sched_ticks_parallel = 0, sched_switches = 0;
+
+/* Devuelve 1 si --fibers no cabe en esta maquina: el planificador queda fijo en serial. */
+static int spawn_actor_threads(void){
+    if (fiber_mode){
+        int r = spawn_actor_fibers();
+        if (r == 0) threads_spawned = 1;
+        if (r > 0) sched_policy = SCHED_FORCE_SERIAL;
+        return r;
+    }
+    int parties = 1 + H + M; // supervisor + heroes + monsters
+    barrier_init(&tick_barrier, parties);
+    barrier_init(&tick_barrier2, parties);
+
+    actor_th = malloc(sizeof(pthread_t) * (size_t)(H + M));
+    if (!actor_th){ fprintf(stderr, "OOM allocating threads\n"); return -1; }
+    for (int h=0; h<H; ++h){
+        if (pthread_create(&actor_th[h], NULL, hero_thread, (void*)(intptr_t)h)!=0){ perror("pthread_create(hero)"); return -1; }
+    }
+    for (int i=0;i<M;i++){
+        if (pthread_create(&actor_th[H + i], NULL, monster_thread, (void*)(intptr_t)i)!=0){
+            perror("pthread_create(monster)"); return -1;
+        }
+    }
+    threads_spawned = 1;
+    return 0;
+}
+
+static void set_serial_mode(int on){
+    pthread_mutex_lock(&mode_mtx);
+    serial_mode = on;
+    if (!on) pthread_cond_broadcast(&mode_cv);
+    pthread_mutex_unlock(&mode_mtx);
+}
+
+/* Marca el fin de la simulacion bajo mode_mtx y despierta a los hilos estacionados
+   (en modo serial no hay barrera que ordene la escritura con su lectura). */
+static void stop_simulation(void){
+    pthread_mutex_lock(&mode_mtx);
+    simulation_over = 1;
+    pthread_cond_broadcast(&mode_cv);
+    pthread_mutex_unlock(&mode_mtx);
+}
+
+/* Modo inicial: en automatico se arranca en serial para medir el costo de los
+   primeros ticks; sched_update decide luego si el modo paralelo compensa. */
+static int sched_start(int live){
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    sched_cpus = ncpu > 0 ? (int)ncpu : 1;
+    int serial = sched_policy != SCHED_FORCE_PARALLEL;
+    if (!serial){
+        int r = spawn_actor_threads();
+        if (r < 0) return -1;
+        if (r > 0) serial = 1;
+    }
+    if (sched_profile){
+        fprintf(stderr, "[sched] inicio: %s (vivos=%d)\n", serial ? "serial" : "paralelo", live);
+    }
+    set_serial_mode(serial);
+    return 0;
+}
+
+/* Costo esperado de un tick paralelo antes de medirlo: las decisiones repartidas entre los
+   nucleos mas el costo fijo de cada actor (vivo o no). Con hilos es despertar a cada uno en
+   las dos barreras; con --fibers, estacionar y reanudar cada fibra mas despertar a cada
+   worker. La aplicacion de las decisiones la hace el supervisor en ambos modos, asi que no
+   cambia la comparacion. Devuelve -1 si el modo paralelo no puede compensar. */
+static long long sched_parallel_estimate(void){
+    int par = sched_cpus;
+    long long fixed = SCHED_THREAD_TICK_NS * (H + M);
+    if (fiber_mode){
+        int w = fiber_workers > 0 ? fiber_workers : sched_cpus;
+        if (w > H + M) w = H + M;
+        if (w < par) par = w;
+        fixed = SCHED_FIBER_TICK_NS * (H + M) + SCHED_THREAD_TICK_NS * w;
+    }
+    if (par < 2) return -1; // un solo nucleo o worker: repartir no acelera nada
+    return sched_serial_ewma / par + fixed;
+}
+
+/* Decide el modo del siguiente tick a partir de los actores vivos y el costo medido.
+   Debe llamarse antes de la Fase B para que los hilos vean el nuevo modo. */
+static int sched_update(int tick, bool ran_serial, int live, long long work_ns){
+    if (ran_serial) sched_ticks_serial++; else sched_ticks_parallel++;
+    if (sched_skip > 0){
+        sched_skip--;
+    } else if (ran_serial){
+        sched_serial_ewma = sched_serial_ewma ? (3*sched_serial_ewma + work_ns) / 4 : work_ns;
+    } else {
+        sched_parallel_ewma = sched_parallel_ewma ? (3*sched_parallel_ewma + work_ns) / 4 : work_ns;
+    }
+    if (sched_policy != SCHED_AUTO) return 0;
+
+    bool want_switch;
+    long long par = sched_parallel_ewma;
+    if (ran_serial){
+        // subir solo si el paralelo (medido, o estimado si aun no se midio) es claramente mas barato
+        if (!par) par = sched_parallel_estimate();
+        want_switch = live > SCHED_SERIAL_MAX_LIVE && par >= 0 &&
+                      sched_serial_ewma * 100 > par * SCHED_PARALLEL_GAIN;
+    } else {
+        // bajar si quedan pocos actores o si el tick paralelo cuesta mas que el serial medido
+        want_switch = live <= SCHED_SERIAL_MAX_LIVE ||
+                      (sched_parallel_ewma > 0 && sched_parallel_ewma > sched_serial_ewma);
+    }
+    sched_streak = want_switch ? sched_streak + 1 : 0;
+    if (sched_streak < SCHED_HOLD_TICKS) return 0;
+    sched_streak = 0;
+
+    if (ran_serial && !threads_spawned){
+        int r = spawn_actor_threads();
+        if (r < 0) return -1;
+        if (r > 0) return 0; // sin fibras: se sigue en serial
+    }
+
+    if (sched_profile){
+        fprintf(stderr, "[sched] tick %d: %s -> %s (vivos=%d, serial=%.1f us/tick, paralelo=%.1f us/tick%s)\n",
+                tick, ran_serial ? "serial" : "paralelo", ran_serial ? "paralelo" : "serial",
+                live, sched_serial_ewma / 1000.0, par / 1000.0, sched_parallel_ewma ? "" : " estimado");
+    }
+    set_serial_mode(!ran_serial);
+    if (ran_serial){
+        sched_parallel_ewma = 0; // medir de nuevo; el primer tick incluye despertar los hilos
+        sched_skip = 1;
+    }
+    sched_switches++;
+    return 0;
+}
+
 // --------------------------- Parser ------------------------------
 static char *ltrim(char *s){ while(*s && isspace((unsigned char)*s)) s++; return s; }
 static void rtrim_inplace(char *s){ size_t n=strlen(s); while(n>0 && isspace((unsigned char)s[n-1])) s[--n]='\0'; }
@@ -275,12 +842,96 @@ static int parse_path_points(const char *src, Point **out_path, int *out_len){
             p += adv;
         } else break;
     }
+    /* devolver el espacio no usado: con muchos heroes, MAX_PATH_POINTS por camino no escala */
+    Point *fit = realloc(buf, sizeof(Point) * (count > 0 ? count : 1));
+    if (fit) buf = fit;
     *out_path = buf; *out_len = count;
     return 0;
 }
 
 typedef struct { int hp, atk, vis, rng, x, y; bool seen_hp, seen_atk, seen_vis, seen_rng, seen_xy; } MProps;
 
+/* Empaqueta HP e indice de perfil en hp_prof; los perfiles (ataque, vision, rango) repetidos
+   se comparten via una tabla hash. Devuelve 0 si hay mas de MON_PROF_MAX perfiles distintos
+   (sin dejar nada reservado), 1 si empaqueto y -1 si falta memoria. */
+#define PROF_HASH_SIZE (2 * MON_PROF_MAX)
+static int monster_store_pack(const MProps *mp, int n, size_t cells){
+    MS.hp_prof = malloc(cells * sizeof(uint32_t));
+    MS.prof = malloc(MON_PROF_MAX * sizeof(MonsterProfile));
+    int *slot = malloc(PROF_HASH_SIZE * sizeof(int));
+    if (!MS.hp_prof || !MS.prof || !slot){ free(slot); return -1; }
+    for (int k = 0; k < (int)PROF_HASH_SIZE; k++) slot[k] = -1;
+
+    for (int i=0;i<n;i++){
+        MonsterProfile p = { mp[i].atk, mp[i].vis, mp[i].rng };
+        uint32_t hs = ((uint32_t)p.attack * 73856093u ^ (uint32_t)p.vision * 19349663u ^ (uint32_t)p.attack_range * 83492791u) % PROF_HASH_SIZE;
+        while (slot[hs] >= 0 && memcmp(&MS.prof[slot[hs]], &p, sizeof(p)) != 0) hs = (hs + 1) % PROF_HASH_SIZE;
+        if (slot[hs] < 0){
+            if ((unsigned)MS.nprof == MON_PROF_MAX){
+                free(slot); free(MS.hp_prof); free(MS.prof);
+                MS.hp_prof = NULL; MS.prof = NULL; MS.nprof = 0;
+                return 0;
+            }
+            MS.prof[MS.nprof] = p;
+            slot[hs] = MS.nprof++;
+        }
+        MS.hp_prof[i] = (uint32_t)mp[i].hp | ((uint32_t)slot[hs] << MON_HP_BITS);
+    }
+    free(slot);
+
+    /* recortar la tabla de perfiles a los usados */
+    MonsterProfile *fit = realloc(MS.prof, (MS.nprof > 0 ? MS.nprof : 1) * sizeof(MonsterProfile));
+    if (fit) MS.prof = fit;
+    return 1;
+}
+
+/* Construye MS a partir de las propiedades ya resueltas y validadas: empaquetado si cabe,
+   formato ancho (HP de 32 bits y un perfil por monstruo) si no. */
+static int monster_store_build(const MProps *mp, int n){
+    memset(&MS, 0, sizeof(MS));
+    MS.coord16 = G.width <= UINT16_MAX && G.height <= UINT16_MAX;
+    size_t cells = n > 0 ? (size_t)n : 1;
+    if (MS.coord16){ MS.x16 = malloc(cells * sizeof(uint16_t)); MS.y16 = malloc(cells * sizeof(uint16_t)); }
+    else           { MS.x32 = malloc(cells * sizeof(int32_t));  MS.y32 = malloc(cells * sizeof(int32_t)); }
+    MS.alive = calloc(bitset_words(n) + 1, sizeof(uint64_t));
+    MS.alerted = calloc(bitset_words(n) + 1, sizeof(uint64_t));
+    MS.target = malloc(cells * sizeof(int32_t));
+    if (!(MS.x16 || MS.x32) || !(MS.y16 || MS.y32) || !MS.alive || !MS.alerted || !MS.target){
+        fprintf(stderr, "OOM allocating monsters\n"); return -1;
+    }
+
+    MS.packed = true;
+    for (int i=0;i<n;i++) if ((unsigned)mp[i].hp > MON_HP_MAX){ MS.packed = false; break; }
+    if (MS.packed){
+        int r = monster_store_pack(mp, n, cells);
+        if (r < 0){ fprintf(stderr, "OOM allocating monsters\n"); return -1; }
+        MS.packed = r == 1;
+    }
+    if (!MS.packed){
+        MS.hp = malloc(cells * sizeof(uint32_t));
+        MS.prof = malloc(cells * sizeof(MonsterProfile));
+        if (!MS.hp || !MS.prof){ fprintf(stderr, "OOM allocating monsters\n"); return -1; }
+        for (int i=0;i<n;i++){
+            MS.hp[i] = (uint32_t)mp[i].hp;
+            MS.prof[i] = (MonsterProfile){ mp[i].atk, mp[i].vis, mp[i].rng };
+        }
+        MS.nprof = n;
+    }
+
+    for (int i=0;i<n;i++){
+        mon_set_xy(i, mp[i].x, mp[i].y);
+        bit_put(MS.alive, i, true);
+    }
+
+    size_t coord_sz = MS.coord16 ? sizeof(uint16_t) : sizeof(int32_t);
+    MS.bytes = cells * (2 * coord_sz + sizeof(uint32_t) + sizeof(int32_t))
+             + 2 * (bitset_words(n) + 1) * sizeof(uint64_t)
+             + (size_t)(MS.nprof > 0 ? MS.nprof : 1) * sizeof(MonsterProfile);
+    return 0;
+}
+
+static size_t parse_peak_bytes = 0; // memoria temporal del parser para monstruos (MProps)
+
 static int load_config(const char *path){
     FILE *f = fopen(path, "r");
     if(!f){ perror("fopen"); return -1; }
@@ -292,15 +943,18 @@ static int load_config(const char *path){
         H = 1;
         heroes = calloc(H, sizeof(Hero));
     }
-    heroes[0].a.hp=100; heroes[0].a.attack=10; heroes[0].a.attack_range=1; heroes[0].a.alive=true;
-    heroes[0].path=NULL; heroes[0].path_len=0; heroes[0].path_idx=0; heroes[0].engaged=false; heroes[0].a.x=0; heroes[0].a.y=0;
-    M=0; monsters=NULL;
+    heroes[0].a.hp=100; heroes[0].a.attack=10; heroes[0].a.attack_range=1;
+    heroes[0].path=NULL; heroes[0].path_len=0; heroes[0].path_idx=0; heroes[0].a.x=0; heroes[0].a.y=0;
+    M=0;
 
     char line[1024];
     int monster_count_declared = -1;
     MProps *mp = NULL;
     int hero_count_declared = -1;
     int last_path_hero = 0; /* index en heroes[] para continuar las lineas de PATH */
+    const int actor_limit = scale_mode ? ACTOR_LIMIT_SCALE : ACTOR_LIMIT;
+    MProps mdef = { .hp = 50, .atk = 10, .vis = 5, .rng = 1 }; /* valores por defecto de monstruos */
+    bool scatter = false; unsigned scatter_seed = 0;
 
     while (fgets(line, sizeof(line), f)){
         rtrim_inplace(line);
@@ -311,7 +965,7 @@ static int load_config(const char *path){
             sscanf(s+9, "%d %d", &G.width, &G.height);
         } else if (strncmp(s, "HERO_COUNT", 10)==0){
             sscanf(s+10, "%d", &hero_count_declared);
-            if (hero_count_declared < 1 || hero_count_declared > 10000){ fprintf(stderr, "Bad HERO_COUNT\n"); fclose(f); return -1; }
+            if (hero_count_declared < 1 || hero_count_declared > actor_limit){ fprintf(stderr, "Bad HERO_COUNT (max %d%s)\n", actor_limit, scale_mode ? "" : ", use --scale for more"); fclose(f); return -1; }
             if (hero_count_declared > 0){
                 /* asignar o redimensionar el array (arreglo) de heroes a la cantidad declarada */
                 if (heroes == NULL){
@@ -323,8 +977,8 @@ static int load_config(const char *path){
                     /* inicializar nuevas entradas si se expande */
                     if (hero_count_declared > H){
                         for (int hh = H; hh < hero_count_declared; ++hh){
-                            tmp[hh].a.hp = 100; tmp[hh].a.attack = 10; tmp[hh].a.attack_range = 1; tmp[hh].a.alive = true;
-                            tmp[hh].path = NULL; tmp[hh].path_len = 0; tmp[hh].path_idx = 0; tmp[hh].engaged = false; tmp[hh].a.x = 0; tmp[hh].a.y = 0;
+                            tmp[hh].a.hp = 100; tmp[hh].a.attack = 10; tmp[hh].a.attack_range = 1;
+                            tmp[hh].path = NULL; tmp[hh].path_len = 0; tmp[hh].path_idx = 0; tmp[hh].a.x = 0; tmp[hh].a.y = 0;
                         }
                     }
                     heroes = tmp;
@@ -371,8 +1025,8 @@ static int load_config(const char *path){
                         if (!tmp){ fprintf(stderr, "OOM allocating heroes\n"); fclose(f); return -1; }
                         /* initialize new entries */
                         for (int hh_i = H; hh_i < newH; ++hh_i){
-                            tmp[hh_i].a.hp = 100; tmp[hh_i].a.attack = 10; tmp[hh_i].a.attack_range = 1; tmp[hh_i].a.alive = true;
-                            tmp[hh_i].path = NULL; tmp[hh_i].path_len = 0; tmp[hh_i].path_idx = 0; tmp[hh_i].engaged = false; tmp[hh_i].a.x = 0; tmp[hh_i].a.y = 0;
+                            tmp[hh_i].a.hp = 100; tmp[hh_i].a.attack = 10; tmp[hh_i].a.attack_range = 1;
+                            tmp[hh_i].path = NULL; tmp[hh_i].path_len = 0; tmp[hh_i].path_idx = 0; tmp[hh_i].a.x = 0; tmp[hh_i].a.y = 0;
                         }
                         heroes = tmp;
                         H = newH;
@@ -389,11 +1043,25 @@ static int load_config(const char *path){
             }
         } else if (strncmp(s, "MONSTER_COUNT", 13)==0){
             sscanf(s+13, "%d", &monster_count_declared);
-            if (monster_count_declared<0 || monster_count_declared>10000){ fprintf(stderr, "Bad MONSTER_COUNT\n"); fclose(f); return -1; }
+            if (monster_count_declared<0 || monster_count_declared>actor_limit){
+                fprintf(stderr, "Bad MONSTER_COUNT (max %d%s)\n", actor_limit, scale_mode ? "" : ", use --scale for more"); fclose(f); return -1;
+            }
             M = monster_count_declared;
-            monsters = calloc(M, sizeof(Monster));
-            mp = calloc(M, sizeof(MProps));
-            if(!monsters||!mp){ fprintf(stderr, "OOM allocating monsters\n"); fclose(f); return -1; }
+            mp = calloc(M > 0 ? M : 1, sizeof(MProps));
+            parse_peak_bytes = (size_t)(M > 0 ? M : 1) * sizeof(MProps);
+            if(!mp){ fprintf(stderr, "OOM allocating monsters\n"); fclose(f); return -1; }
+        } else if (strncmp(s, "MONSTER_DEFAULT_", 16)==0){
+            // MONSTER_DEFAULT_HP v, etc.: valores para los monstruos que no declaran el campo
+            char key[64]; int v;
+            if (sscanf(s+16, "%63s %d", key, &v) == 2){
+                if (strcmp(key, "HP")==0) mdef.hp = v;
+                else if (strcmp(key, "ATTACK_DAMAGE")==0) mdef.atk = v;
+                else if (strcmp(key, "VISION_RANGE")==0) mdef.vis = v;
+                else if (strcmp(key, "ATTACK_RANGE")==0) mdef.rng = v;
+            }
+        } else if (strncmp(s, "MONSTER_SCATTER", 15)==0){
+            // MONSTER_SCATTER seed: repartir por la cuadricula los monstruos sin COORDS
+            if (sscanf(s+15, "%u", &scatter_seed) == 1) scatter = true;
         } else if (strncmp(s, "MONSTER_", 8)==0){
             // MONSTER_i_HP v, MONSTER_i_COORDS x y, etc.
             int idx = -1; char key[64];
@@ -410,21 +1078,24 @@ static int load_config(const char *path){
     }
     fclose(f);
 
-    if (M>0){
-        for (int i=0;i<M;i++){
-            monsters[i].id = i+1;
-            monsters[i].a.hp = mp[i].seen_hp ? mp[i].hp : 50;
-            monsters[i].a.attack = mp[i].seen_atk ? mp[i].atk : 10;
-            monsters[i].vision = mp[i].seen_vis ? mp[i].vis : 5;
-            monsters[i].a.attack_range = mp[i].seen_rng ? mp[i].rng : 1;
-            monsters[i].a.x = mp[i].seen_xy ? mp[i].x : 0;
-            monsters[i].a.y = mp[i].seen_xy ? mp[i].y : 0;
-            monsters[i].a.alive = true;
-            monsters[i].alerted = false;
+    /* resolver los valores por defecto en mp; el formato compacto se construye tras validar */
+    uint32_t rng_state = scatter_seed;
+    for (int i=0;i<M;i++){
+        if (!mp[i].seen_hp) mp[i].hp = mdef.hp;
+        if (!mp[i].seen_atk) mp[i].atk = mdef.atk;
+        if (!mp[i].seen_vis) mp[i].vis = mdef.vis;
+        if (!mp[i].seen_rng) mp[i].rng = mdef.rng;
+        if (!mp[i].seen_xy){
+            mp[i].x = 0; mp[i].y = 0;
+            if (scatter){
+                rng_state = rng_state * 1664525u + 1013904223u;
+                mp[i].x = (int)((rng_state >> 8) % (uint32_t)(G.width + 1));
+                rng_state = rng_state * 1664525u + 1013904223u;
+                mp[i].y = (int)((rng_state >> 8) % (uint32_t)(G.height + 1));
+            }
         }
     }
     /* La cantidad de heroes declarada (hero_count_declared) se gestiono mediante la asignacion de memoria al arreglo heroes[] arriba */
-    free(mp);
 
     // --- Validaciones post-parse ---
     if (G.width < 1 || G.height < 1){ fprintf(stderr, "Bad GRID_SIZE\n"); return -1; }
@@ -441,12 +1112,20 @@ static int load_config(const char *path){
         }
     }
     for (int i=0;i<M;i++){
-        Monster *mm = &monsters[i];
-        if (mm->a.hp < 0 || mm->a.attack < 0 || mm->a.attack_range < 0 || mm->vision < 0){ fprintf(stderr, "Monster %d has negative params\n", i+1); return -1; }
-        if (!IN(mm->a.x, 0, G.width) || !IN(mm->a.y, 0, G.height)){ fprintf(stderr, "Monster %d coords OOB\n", i+1); return -1; }
+        MProps *mm = &mp[i];
+        if (mm->hp < 0 || mm->atk < 0 || mm->rng < 0 || mm->vis < 0){ fprintf(stderr, "Monster %d has negative params\n", i+1); return -1; }
+        if (!IN(mm->x, 0, G.width) || !IN(mm->y, 0, G.height)){ fprintf(stderr, "Monster %d coords OOB\n", i+1); return -1; }
     }
     /* end validations */
 
+    if (monster_store_build(mp, M)!=0){ free(mp); return -1; }
+    free(mp);
+
+    hero_alive = calloc(bitset_words(H), sizeof(uint64_t));
+    hero_engaged = calloc(bitset_words(H), sizeof(uint64_t));
+    if (!hero_alive || !hero_engaged){ fprintf(stderr, "OOM allocating heroes\n"); return -1; }
+    for (int h=0; h<H; ++h) bit_put(hero_alive, h, true);
+
     return 0;
 }
 
@@ -457,170 +1136,236 @@ static void print_state(int tick){
         Hero *hh = &heroes[h];
         printf(" HERO%02d (%d,%d) HP=%d %s\n",
                h+1, hh->a.x, hh->a.y, hh->a.hp,
-               hh->engaged ? "[PELEANDO]" : "");
+               hero_is_engaged(h) ? "[PELEANDO]" : "");
     }
     for (int i = 0; i < M; i++){
-        Monster *m = &monsters[i];
-    const char *life = m->a.alive ? "VIVO" : "MUERTO";
-    const char *alrt = (m->a.alive && m->alerted) ? "ALERTADO" : "";
+    const char *life = mon_is_alive(i) ? "VIVO" : "MUERTO";
+    const char *alrt = (mon_is_alive(i) && mon_is_alerted(i)) ? "ALERTADO" : "";
     printf("  M%02d (%d,%d) HP=%d %s %s\n",
-           m->id, m->a.x, m->a.y, m->a.hp,
+           i+1, mon_x(i), mon_y(i), mon_hp(i),
            life,
            alrt);
     }
 }
 
+// Ventana visible del mundo para un tick (coordenadas del mundo, inclusivas)
+typedef struct {
+    int x0, y0;      // esquina inferior izquierda de la ventana
+    int w, h;        // celdas del mundo cubiertas
+    int zoom;        // lado del bloque de celdas agregado en cada glifo
+    int cols, rows;  // glifos de salida
+    bool partial;    // la ventana no cubre todo el mundo
+} View;
+
+static View compute_view(void){
+    View v;
+    const int world_w = G.width + 1, world_h = G.height + 1;
+    bool follow = view_follow >= 0 && view_follow < H;
+    v.w = view_w > 0 ? view_w : (follow ? FOLLOW_DEFAULT_W : world_w);
+    v.h = view_h > 0 ? view_h : (follow ? FOLLOW_DEFAULT_H : world_h);
+    if (v.w > world_w) v.w = world_w;
+    if (v.h > world_h) v.h = world_h;
+
+    v.x0 = view_x0; v.y0 = view_y0;
+    if (follow){
+        // camara centrada en el heroe seguido
+        v.x0 = heroes[view_follow].a.x - v.w / 2;
+        v.y0 = heroes[view_follow].a.y - v.h / 2;
+    }
+    // mantener la ventana dentro del mundo
+    if (v.x0 > world_w - v.w) v.x0 = world_w - v.w;
+    if (v.y0 > world_h - v.h) v.y0 = world_h - v.h;
+    if (v.x0 < 0) v.x0 = 0;
+    if (v.y0 < 0) v.y0 = 0;
+
+    v.zoom = view_zoom > 1 ? view_zoom : 1;
+    v.cols = (v.w + v.zoom - 1) / v.zoom;
+    v.rows = (v.h + v.zoom - 1) / v.zoom;
+    v.partial = v.w < world_w || v.h < world_h;
+    return v;
+}
+
+// indice del glifo que cubre (x,y), o -1 si esta fuera de la ventana
+static inline int view_cell(const View *v, int x, int y){
+    if (x < v->x0 || x >= v->x0 + v->w || y < v->y0 || y >= v->y0 + v->h) return -1;
+    return ((y - v->y0) / v->zoom) * v->cols + (x - v->x0) / v->zoom;
+}
+
+// marca '.' en el tramo horizontal (xa..xb, y) recortado a la ventana
+static void view_mark_hline(const View *v, char *cells, int y, int xa, int xb){
+    if (y < v->y0 || y >= v->y0 + v->h) return;
+    if (xa > xb){ int t = xa; xa = xb; xb = t; }
+    if (xa < v->x0) xa = v->x0;
+    if (xb > v->x0 + v->w - 1) xb = v->x0 + v->w - 1;
+    for (int x = xa; x <= xb; ++x) cells[view_cell(v, x, y)] = '.';
+}
+
+// marca '.' en el tramo vertical (x, ya..yb) recortado a la ventana
+static void view_mark_vline(const View *v, char *cells, int x, int ya, int yb){
+    if (x < v->x0 || x >= v->x0 + v->w) return;
+    if (ya > yb){ int t = ya; ya = yb; yb = t; }
+    if (ya < v->y0) ya = v->y0;
+    if (yb > v->y0 + v->h - 1) yb = v->y0 + v->h - 1;
+    for (int y = ya; y <= yb; ++y) cells[view_cell(v, x, y)] = '.';
+}
+
+// glifo de densidad para un bloque con n monstruos vivos (minusculas si alguno esta alertado)
+static char density_glyph(int n, bool alerted){
+    if (n >= 10) return alerted ? '@' : '#';
+    return alerted ? (char)('a' + n - 1) : (char)('0' + n);
+}
+
 static void render_ascii_grid(int tick, const char *title){
     const int W = G.width, GH = G.height;
-
-    // reservar una cuadricula de (GH+1 x W+1) ya que las coordenadas (de 0 a W y 0 a GH) son inclusivas
-    char **grid = (char**)malloc((GH+1)*sizeof(char*));
-    for (int y=0; y<=GH; ++y){
-        grid[y] = (char*)malloc((W+1)*sizeof(char));
-        memset(grid[y], ' ', (W+1)*sizeof(char));
+    const View v = compute_view();
+    const int ncell = v.cols * v.rows;
+
+    // reservar solo los glifos de la ventana (no la cuadricula completa del mundo)
+    char *cells = malloc((size_t)ncell);
+    int *mcount = NULL;
+    bool *malert = NULL;
+    memset(cells, ' ', (size_t)ncell);
+    if (v.zoom > 1){
+        mcount = calloc((size_t)ncell, sizeof(int));
+        malert = calloc((size_t)ncell, sizeof(bool));
     }
 
-    // draw paths for each hero as '.'
+    // dibujar el camino de cada heroe como '.'; cada tramo se mueve primero en X y luego en Y
+    // (movimiento en L), asi que se recorta como un segmento horizontal y uno vertical
     if (ascii_show_path) {
         for (int h = 0; h < H; ++h) {
             Hero *hh = &heroes[h];
             if (!hh->path || hh->path_len <= 0) continue; // Salta si no hay camino
 
             int px = hh->a.x, py = hh->a.y; // Posicion de partida para el tramo actual
+            view_mark_hline(&v, cells, py, px, px);
 
-            // Marca el punto de partida (si esta dentro del grid)
-            if (py >= 0 && py <= GH && px >= 0 && px <= W) {
-                grid[py][px] = '.';
-            }
-
-            // Recorre cada punto objetivo (waypoint) del camino
             for (int i = 0; i < hh->path_len; i++) {
-                int tx = hh->path[i].x; // Coordenada X objetivo
-                int ty = hh->path[i].y; // Coordenada Y objetivo
-
-                // --- Calculo de pasos sx y sy
-                int sx = 0; // Paso horizontal por defecto es 0
-                if (tx > px) {
-                    sx = 1; // Si el objetivo esta a la derecha, paso es +1
-                } else if (tx < px) {
-                    sx = -1; // Si el objetivo esta a la izquierda, paso es -1
-                }   // Si tx == px, sx se queda en 0
-
-                int sy = 0; // Paso vertical por defecto es 0
-                if (ty > py) {
-                    sy = 1; // Si el objetivo esta arriba, paso es +1
-                } else if (ty < py) {
-                sy = -1; // Si el objetivo esta abajo, paso es -1
-                } // Si ty == py, sy se queda en 0
-                // Fin del calculo de pasos 
-
-                int x = px, y = py; // Coordenadas temporales para dibujar el tramo
-
-                // Dibuja el tramo paso a paso hasta el objetivo (tx, ty)
-                while (x != tx || y != ty) {
-                    // Mueve primero en X, luego en Y (movimiento en L)
-                    if (x != tx) {
-                        x += sx;
-                    } else if (y != ty) {
-                        y += sy;
-                    }
-
-                    // Dibuja un punto '.' si la nueva posicion esta en el grid y vacia
-                    if (y >= 0 && y <= GH && x >= 0 && x <= W) {
-                        if (grid[y][x] == ' ') {
-                            grid[y][x] = '.';
-                        }
-                    }
-                }
-                // Actualiza la posicion de partida para el siguiente tramo
+                int tx = hh->path[i].x, ty = hh->path[i].y;
+                view_mark_hline(&v, cells, py, px, tx);
+                view_mark_vline(&v, cells, tx, py, ty);
                 px = tx;
                 py = ty;
             }
         }
     }
 
-    // Dibujar monstruos (1..9 para los primeros 9, 'M' para los demas)
-    for (int i=0;i<M;i++) if (monsters[i].a.alive){
-        int x=monsters[i].a.x, y=monsters[i].a.y;
-    if (y>=0 && y<=GH && x>=0 && x<=W){
-            char mc = (monsters[i].id<10)?('0'+monsters[i].id):'M';
-            grid[y][x] = mc;
+    // Dibujar monstruos (1..9 para los primeros 9, 'M' para los demas; con zoom, densidad por bloque)
+    int vis_h = 0, vis_m = 0, vis_alert = 0; // actores vivos dentro de la ventana
+    for (int i=0;i<M;i++) if (mon_is_alive(i)){
+        int c = view_cell(&v, mon_x(i), mon_y(i));
+        if (c < 0) continue;
+        vis_m++;
+        if (mon_is_alerted(i)) vis_alert++;
+        if (v.zoom == 1){
+            cells[c] = (i+1<10)?('0'+i+1):'M';
+        } else {
+            mcount[c]++;
+            if (mon_is_alerted(i)) malert[c] = true;
         }
     }
+    if (v.zoom > 1){
+        for (int c = 0; c < ncell; ++c) if (mcount[c] > 0) cells[c] = density_glyph(mcount[c], malert[c]);
+    }
 
     // dibujar heroes (A..Z para los primeros 26 heroes, 'H' para los demas)
     for (int h=0; h<H; ++h){
         Hero *hh = &heroes[h];
-    if (!hh->a.alive) continue;
-    int x=hh->a.x, y=hh->a.y;
-    if (y>=0 && y<=GH && x>=0 && x<=W){
-            char c;
-            if (h < 26) c = (char)('A' + h);
-            else c = 'H';
-            grid[y][x] = c;
-        }
+        if (!hero_is_alive(h)) continue;
+        int c = view_cell(&v, hh->a.x, hh->a.y);
+        if (c < 0) continue;
+        vis_h++;
+        cells[c] = (h < 26) ? (char)('A' + h) : 'H';
     }
 
     // header
     if (title) printf("%s\n", title);
     printf("Grid %dx%d   Tick %d\n", W, GH, tick);
+    if (v.partial || v.zoom > 1){
+        printf("Vista x=%d..%d y=%d..%d", v.x0, v.x0 + v.w - 1, v.y0, v.y0 + v.h - 1);
+        if (v.zoom > 1) printf("  zoom %dx%d", v.zoom, v.zoom);
+        if (view_follow >= 0 && view_follow < H) printf("  siguiendo HERO%02d", view_follow + 1);
+        printf("\n");
+    }
+
+    // ancho de la etiqueta del eje Y (al menos 3, como en la vista completa)
+    int lw = 3;
+    for (int top = v.y0 + v.h - 1; top >= 1000; top /= 10) lw++;
 
     // top border
-    printf("   +"); for(int x=0;x<=W;x++) printf("-"); printf("+\n");
+    printf("%*s+", lw, ""); for(int c=0;c<v.cols;c++) putchar('-'); printf("+\n");
 
     //filas (se dibujan de arriba hacia abajo, para que el eje Y se vea creciendo hacia arriba)
-        for (int y=GH; y>=0; --y){
-        printf("%3d|", y);
-        for (int x=0; x<=W; ++x) putchar(grid[y][x]);
+    for (int r = v.rows - 1; r >= 0; --r){
+        printf("%*d|", lw, v.y0 + r * v.zoom);
+        fwrite(cells + (size_t)r * v.cols, 1, (size_t)v.cols, stdout);
         printf("|\n");
     }
 
     // border de abajo
-    printf("   +"); for(int x=0;x<=W;x++) printf("-"); printf("+\n");
-
-    // etiquetas eje x: mostrar digito de las decenas en multiplos de 10 y unidades en multiplos de 10
-    printf("    ");
-    for (int x = 0; x <= W; x++){
-        if ((x % 10) == 0){
-            int tens = (x / 10) % 10;
-            printf("%c", (char)('0' + tens));
-        } else {
-            putchar(' ');
-        }
+    printf("%*s+", lw, ""); for(int c=0;c<v.cols;c++) putchar('-'); printf("+\n");
+
+    // etiquetas eje x: digito de las decenas en la columna que contiene un multiplo de 10,
+    // y digito de las unidades de la primera celda de cada columna
+    printf("%*s", lw + 1, "");
+    for (int c = 0; c < v.cols; c++){
+        int x = v.x0 + c * v.zoom;
+        int m = ((x + 9) / 10) * 10; // primer multiplo de 10 >= x
+        if (m < x + v.zoom) putchar((char)('0' + (m / 10) % 10));
+        else putchar(' ');
     }
-    printf("\n    ");
-    for (int x = 0; x <= W; x++){
+    printf("\n%*s", lw + 1, "");
+    for (int c = 0; c < v.cols; c++){
         /* muestra el digito de las unidades para cada columna (se repite de 0 a 9) */
-        putchar((char)('0' + (x % 10)));
+        putchar((char)('0' + ((v.x0 + c * v.zoom) % 10)));
     }
     printf("\n");
 
-    // legend and state
-    printf("Leyenda: A..Z=Heroes, 1..9=Monsters (id), '.'=Heroe camino planeado\n");
-    for (int h=0; h<H; ++h){
-        Hero *hh = &heroes[h];
-        printf("HERO%02d HP=%d at (%d,%d)%s\n",
-               h+1, hh->a.hp, hh->a.x, hh->a.y, hh->engaged ? " [PELEANDO]" : "");
-    }
-    for (int i=0;i<M;i++){
-    const char *life = monsters[i].a.alive ? "VIVO" : "MUERTO";
-    const char *alrt = (monsters[i].a.alive && monsters[i].alerted) ? "ALERTA" : "";
-    printf("M%02d at (%d,%d) HP=%d %s %s\n",
-           monsters[i].id, monsters[i].a.x, monsters[i].a.y,
-           monsters[i].a.hp,
-           life,
-           alrt);
+    // legend and state: con zoom solo totales; con zoom 1, los actores de la ventana
+    // (hasta RENDER_LIST_MAX) para que la salida escale con la vista y no con el mundo
+    if (v.zoom > 1){
+        printf("Leyenda: A..Z=Heroes, 1..9/#=Monsters por bloque, a..i/@=bloque con monstruo alertado, '.'=Heroe camino planeado\n");
+        printf("En la vista: %d heroes vivos, %d monstruos vivos (%d alertados)\n", vis_h, vis_m, vis_alert);
+        printf("Total: %d heroes, %d monstruos\n", H, M);
+    } else {
+        printf("Leyenda: A..Z=Heroes, 1..9=Monsters (id), '.'=Heroe camino planeado\n");
+        int hidden_h = 0, hidden_m = 0, listed = 0, unlisted = 0;
+        for (int h=0; h<H; ++h){
+            Hero *hh = &heroes[h];
+            if (v.partial && view_cell(&v, hh->a.x, hh->a.y) < 0){ hidden_h++; continue; }
+            if (listed >= RENDER_LIST_MAX){ unlisted++; continue; }
+            listed++;
+            printf("HERO%02d HP=%d at (%d,%d)%s\n",
+                   h+1, hh->a.hp, hh->a.x, hh->a.y, hero_is_engaged(h) ? " [PELEANDO]" : "");
+        }
+        for (int i=0;i<M;i++){
+            if (v.partial && view_cell(&v, mon_x(i), mon_y(i)) < 0){ hidden_m++; continue; }
+            if (listed >= RENDER_LIST_MAX){ unlisted++; continue; }
+            listed++;
+            const char *life = mon_is_alive(i) ? "VIVO" : "MUERTO";
+            const char *alrt = (mon_is_alive(i) && mon_is_alerted(i)) ? "ALERTA" : "";
+            printf("M%02d at (%d,%d) HP=%d %s %s\n",
+                   i+1, mon_x(i), mon_y(i),
+                   mon_hp(i),
+                   life,
+                   alrt);
+        }
+        if (unlisted) printf("(%d actores mas en la vista)\n", unlisted);
+        if (hidden_h || hidden_m) printf("(%d heroes y %d monstruos fuera de la vista)\n", hidden_h, hidden_m);
     }
 
-    for (int y=0;y<=GH;y++) free(grid[y]);
-    free(grid);
+    free(malert);
+    free(mcount);
+    free(cells);
 }
 
 // ----------------------------- Main ------------------------------
 int main(int argc, char **argv){
     if (argc<2){
-        fprintf(stderr, "Usage: %s <config.txt> [tick_us] [--ascii] [--ascii-only]\n", argv[0]);
-        fprintf(stderr, "Examples:\n  %s config.txt 20000 --ascii\n  %s config.txt --ascii-only\n", argv[0], argv[0]);
+        fprintf(stderr, "Usage: %s <config.txt> [tick_us] [--ascii] [--ascii-only] [--serial|--parallel] [--profile]\n"
+                        "       [--view x0,y0,w,h] [--follow HERO_n] [--zoom k] [--scale] [--bench]\n"
+                        "       [--fibers [--workers N]]\n", argv[0]);
+        fprintf(stderr, "Examples:\n  %s config.txt 20000 --ascii\n  %s config.txt --ascii-only\n  %s config.txt --ascii --follow HERO_1 --zoom 2\n", argv[0], argv[0], argv[0]);
         return 1;
     }
 
@@ -628,14 +1373,54 @@ int main(int argc, char **argv){
     for (int i=2;i<argc;i++){
         if (strcmp(argv[i], "--ascii")==0) ascii_live=1;
         else if (strcmp(argv[i], "--ascii-only")==0) ascii_only=1;
+        else if (strcmp(argv[i], "--serial")==0) sched_policy=SCHED_FORCE_SERIAL;
+        else if (strcmp(argv[i], "--parallel")==0) sched_policy=SCHED_FORCE_PARALLEL;
+        else if (strcmp(argv[i], "--profile")==0) sched_profile=1;
+        else if (strcmp(argv[i], "--scale")==0) scale_mode=1;
+        else if (strcmp(argv[i], "--bench")==0) bench_mode=1;
+        else if (strcmp(argv[i], "--fibers")==0) fiber_mode=1;
+        else if (strcmp(argv[i], "--workers")==0 && i+1<argc){
+            fiber_workers = atoi(argv[++i]);
+            if (fiber_workers < 1){ fprintf(stderr, "Bad --workers\n"); return 1; }
+        }
+        else if (strcmp(argv[i], "--view")==0 && i+1<argc){
+            if (sscanf(argv[++i], "%d,%d,%d,%d", &view_x0, &view_y0, &view_w, &view_h)!=4 || view_w<1 || view_h<1){
+                fprintf(stderr, "Bad --view (expected x0,y0,w,h)\n"); return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--follow")==0 && i+1<argc){
+            int n = 0;
+            if ((sscanf(argv[++i], "HERO_%d", &n)!=1 && sscanf(argv[i], "%d", &n)!=1) || n < 1){
+                fprintf(stderr, "Bad --follow (expected HERO_n with n >= 1)\n"); return 1;
+            }
+            view_follow = n-1;
+        }
+        else if (strcmp(argv[i], "--zoom")==0 && i+1<argc){
+            view_zoom = atoi(argv[++i]);
+            if (view_zoom < 1){ fprintf(stderr, "Bad --zoom\n"); return 1; }
+        }
         else if (isdigit((unsigned char)argv[i][0])) tick_us = atoi(argv[i]);
     }
 
+    if (fiber_workers > 0 && !fiber_mode){ fprintf(stderr, "--workers requires --fibers\n"); return 1; }
+
+    if (scale_mode && !fiber_mode){
+        // sin un hilo por actor: el supervisor ejecuta todos los ticks inline (o --fibers)
+        if (sched_policy == SCHED_FORCE_PARALLEL){ fprintf(stderr, "--parallel with --scale requires --fibers\n"); return 1; }
+        sched_policy = SCHED_FORCE_SERIAL;
+    }
+
+    long long load_t0 = now_ns();
     if (load_config(argv[1])!=0){
         fprintf(stderr, "Failed to load config\n");
         return 1;
     }
 
+    if (view_follow != -1 && (view_follow < 0 || view_follow >= H)){
+        fprintf(stderr, "--follow: hero %d out of range\n", view_follow+1); return 1;
+    }
+
+    long long load_ns = now_ns() - load_t0;
     printf("Grid %dx%d, Heroes=%d, Monsters=%d\n", G.width, G.height, H, M);
 
     if (ascii_only){
@@ -644,35 +1429,47 @@ int main(int argc, char **argv){
         return 0;
     }
 
-    // Threads + barrier
-    int parties = 1 + H + M; // supervisor + heroes + monsters
-    barrier_init(&tick_barrier, parties);
-    barrier_init(&tick_barrier2, parties);
-
-    // create hero threads
-    for (int h=0; h<H; ++h){
-        if (pthread_create(&heroes[h].th, NULL, hero_thread, (void*)(intptr_t)h)!=0){ perror("pthread_create(hero)"); return 1; }
-    }
-    for (int i=0;i<M;i++){
-        if (pthread_create(&monsters[i].th, NULL, monster_thread, (void*)(intptr_t)i)!=0){
-            perror("pthread_create(monster)"); return 1;
-        }
-    }
+    // Threads + barrier: los hilos se crean al entrar por primera vez en modo paralelo
+    int live = count_monsters_alive();
+    for (int h=0; h<H; ++h) if (hero_is_alive(h)) live++;
+    if (sched_start(live)!=0) return 1;
 
     // Supervisor loop
     int tick=0;
+    long long bench_ns = 0;
     for(;;){
-    // Fase 1: esperar a que los actors terminen las acciones de este tick
-    barrier_wait(&tick_barrier);
+    bool ran_serial = serial_mode;
+    long long t0 = now_ns();
+    if (ran_serial){
+        // Modo serial: el supervisor toma las decisiones del tick inline, sin barreras
+        for (int h=0; h<H; ++h) hero_decide(h);
+        for (int i=0; i<M; ++i) monster_decide(i);
+    } else {
+        // Fase 1: esperar a que los actors terminen de decidir
+        barrier_wait(&tick_barrier);
+    }
+    // Aplicar las decisiones en orden. Hasta la Fase 2 los actors no leen el mundo,
+    // asi que el supervisor es el unico que lo escribe y no hace falta un candado.
+    for (int h=0; h<H; ++h) hero_act_index(h);
+    for (int i=0; i<M; ++i) monster_act(i);
+    long long work_ns = now_ns() - t0;
+    if (ran_serial){
+        if (tick_us>0) sleep_us(tick_us);
+    } else {
+        work_ns -= (long long)tick_us * 1000LL;
+        if (work_ns < 0) work_ns = 0;
+    }
 
-    pthread_mutex_lock(&world_mtx);
-    bool monsters_alive = any_monster_alive();
+    int monsters_alive_n = count_monsters_alive();
+    bool monsters_alive = monsters_alive_n > 0;
     bool all_heroes_at_goal = true;
     bool any_hero_alive = false;
+    live = monsters_alive_n;
 
     for (int h = 0; h < H; ++h) {
-        if (heroes[h].a.alive) {
+        if (hero_is_alive(h)) {
             any_hero_alive = true; // al menos uno esta vivo
+            live++;
 
             // Solo consideramos el progreso de heroes VIVOS
             if (heroes[h].path_idx < heroes[h].path_len) {
@@ -687,7 +1484,9 @@ int main(int argc, char **argv){
         if (any_monster_alive_in_range(heroes[h].a.x, heroes[h].a.y, heroes[h].a.attack_range, &dummy)) { combat_now = true; break; }
     }
 
-    if (ascii_live){
+    if (bench_mode){
+        // sin salida por tick: solo se mide el tiempo de simulacion
+    } else if (ascii_live){
         ansi_clear();
         render_ascii_grid(tick, "Simulacion - Vista ASCII");
     } else {
@@ -696,31 +1495,60 @@ int main(int argc, char **argv){
     // verificar condiciones de finalizacion
     if (!any_hero_alive){
         printf("\n>>> Todos los heroes murieron en el tick %d. GAME OVER.\n", tick);
-        simulation_over = 1;
+        stop_simulation();
     } else if (all_heroes_at_goal && !combat_now){
         printf("\n>>> Todos los heroes alcanzaron sus objetivos en el tick %d. %s\n",
                tick, monsters_alive ? "Los monstruos permanecen, pero los heroes terminaron sus caminos." : "Todos los monstruos fueron eliminados.");
-        simulation_over = 1;
+        stop_simulation();
     } else if (!monsters_alive){
         printf("\n>>> TODOS LOS MONSTRUOS MUERTOS en el tick %d.\n", tick);
-        simulation_over = 1;
+        stop_simulation();
+    }
+
+    // Elegir el modo del siguiente tick antes de la Fase 2 (los actors lo leen al salir)
+    if (!simulation_over && sched_update(tick, ran_serial, live, work_ns)!=0) return 1;
+
+    if (!ran_serial){
+        // Fase 2: permitir que los actors observen simulation_over antes de comenzar un nuevo tick
+        // El supervisor establece simulation_over entre las dos barreras, luego
+        // espera en la segunda barrera para liberar a los actors en el siguiente ciclo.
+        barrier_wait(&tick_barrier2);
     }
-    pthread_mutex_unlock(&world_mtx);
-    // Fase 2: permitir que los actors observen simulation_over antes de comenzar un nuevo tick
-    // El supervisor establece simulation_over mientras sostiene world_mtx, luego
-    // espera en la segunda barrera para liberar a los actors en el siguiente ciclo.
-    barrier_wait(&tick_barrier2);
 
+    bench_ns += now_ns() - t0;
     if (simulation_over) break;
     tick++;
     }
 
+    if (bench_mode){
+        printf("[bench] heroes=%d monsters=%d ticks=%d carga=%.1f ms\n", H, M, tick + 1, load_ns / 1e6);
+        double per = M > 0 ? (double)MS.bytes / M : 0.0;
+        long long rss = peak_rss_bytes();
+        printf("[bench] memoria por monstruo: %.2f bytes medidos (store %.1f MiB, %s, %d perfiles); %.2f bytes teoricos por slot (coords %d bits)\n",
+               per, MS.bytes / 1048576.0, MS.packed ? "empaquetado" : "formato ancho", MS.nprof,
+               monster_slot_bytes(), MS.coord16 ? 16 : 32);
+        printf("[bench] parseo: %.2f bytes temporales por monstruo (MProps); RSS maximo %.1f MiB (%.2f bytes por actor)\n",
+               M > 0 ? (double)parse_peak_bytes / M : 0.0, rss / 1048576.0, (double)rss / (H + M));
+        printf("[bench] tick promedio: %.1f us (total %.1f ms)\n", bench_ns / 1e3 / (tick + 1), bench_ns / 1e6);
+    }
+
+    if (sched_profile){
+        fprintf(stderr, "[sched] ticks serial=%d paralelo=%d cambios=%d\n",
+                sched_ticks_serial, sched_ticks_parallel, sched_switches);
+    }
+
     // Join threads
-    for (int h=0; h<H; ++h) pthread_join(heroes[h].th, NULL);
-    for (int i=0;i<M;i++) pthread_join(monsters[i].th, NULL);
+    if (threads_spawned && fiber_mode){
+        join_actor_fibers();
+    } else if (threads_spawned){
+        for (int t=0; t<H+M; ++t) pthread_join(actor_th[t], NULL);
+        free(actor_th);
+    }
 
     for (int h=0; h<H; ++h) free(heroes[h].path);
-    free(monsters);
+    monster_store_free();
+    free(hero_engaged);
+    free(hero_alive);
     free(heroes);
     return 0;
 }